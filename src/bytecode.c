@@ -0,0 +1,538 @@
+#include "bytecode.h"
+#include <assert.h>
+#include <stdlib.h>
+
+// Labels as values let every handler jump straight to the next one instead of
+// going back through a single switch, which predicts much better. Define
+// CRYOLITE_NO_COMPUTED_GOTO to build the portable switch loop instead.
+#if defined(__GNUC__) && !defined(CRYOLITE_NO_COMPUTED_GOTO)
+#define CRYOLITE_COMPUTED_GOTO 1
+#endif
+
+void initChunk(Chunk *chunk) {
+    chunk->code = 0;
+    chunk->size = 0;
+    chunk->capacity = 0;
+    chunk->numRegs = 0;
+    chunk->numParams = 0;
+}
+
+void freeChunk(Chunk *chunk) {
+    free(chunk->code);
+    initChunk(chunk);
+}
+
+unsigned emitInstr(Chunk *chunk, Opcode op, unsigned a, unsigned b, unsigned c, long long k) {
+    if (chunk->size == chunk->capacity) {
+        chunk->capacity = chunk->capacity ? chunk->capacity * 2 : 16;
+        chunk->code = (Instr *)realloc(chunk->code, chunk->capacity * sizeof(Instr));
+    }
+    Instr *in = &chunk->code[chunk->size];
+    in->op = (unsigned char)op;
+    in->a = (unsigned char)a;
+    in->b = (unsigned char)b;
+    in->c = (unsigned char)c;
+    in->k = k;
+    return chunk->size++;
+}
+
+// Lowering - State threaded through the lowering of one expression tree.
+// Registers are handed out in stack order: a subexpression may only clobber
+// registers at or above nextReg. Once failed is set, lowering carries on so
+// that the callers need not check, but the chunk must not be run.
+typedef struct Lowering {
+    Chunk *chunk;
+    unsigned nextReg;
+    VarDecl **params;
+    unsigned numParams;
+    _Bool failed;
+} Lowering;
+
+static unsigned allocReg(Lowering *l) {
+    unsigned r = l->nextReg++;
+    if (r >= MAX_REGISTERS) {
+        // Keep the register number encodable; the chunk is rejected anyway.
+        l->failed = 1;
+        return MAX_REGISTERS - 1;
+    }
+    if (l->nextReg > l->chunk->numRegs)
+        l->chunk->numRegs = l->nextReg;
+    return r;
+}
+
+static void releaseReg(Lowering *l, unsigned r) {
+    assert((l->failed || r == l->nextReg - 1) && "registers must be released in stack order");
+    (void)r;
+    --l->nextReg;
+}
+
+// formatOf - Return the integer format of e's type. Lowering fails if e is not
+// of integer type.
+static IntegerFormat formatOf(Lowering *l, Expr *e) {
+    IntegerFormat fmt = {64, 1};
+    if (!getIntegerFormat(e->tr, &fmt))
+        l->failed = 1;
+    return fmt;
+}
+
+// emitNormalize - Bring the 64-bit value in reg back into the range of fmt.
+static void emitNormalize(Lowering *l, unsigned reg, IntegerFormat fmt) {
+    if (fmt.width == 1)
+        emitInstr(l->chunk, OP_BOOL, reg, reg, 0, 0);
+    else if (fmt.width < 64)
+        emitInstr(l->chunk, fmt.isSigned ? OP_SEXT : OP_ZEXT, reg, reg, 0, fmt.width);
+}
+
+// emitConvert - Convert the value in reg from one integer format to another.
+// Nothing is emitted if every value of from is already a valid value of to.
+static void emitConvert(Lowering *l, unsigned reg, IntegerFormat from, IntegerFormat to) {
+    if (from.width == to.width && from.isSigned == to.isSigned)
+        return;
+    if (to.width == 64 || (from.width < to.width && (!from.isSigned || to.isSigned)))
+        return;
+    emitNormalize(l, reg, to);
+}
+
+// NO_JUMP - Returned instead of an instruction index when a condition is known
+// never to take its jump, so nothing was emitted.
+#define NO_JUMP ((unsigned)-1)
+
+static void patchJump(Chunk *chunk, unsigned at) {
+    if (at != NO_JUMP)
+        chunk->code[at].k = chunk->size;
+}
+
+// exactLog2 - Return k if value is 2^k, or -1 otherwise.
+static int exactLog2(long long value) {
+    if (value <= 0 || (value & (value - 1)))
+        return -1;
+    int k = 0;
+    while (value >>= 1)
+        ++k;
+    return k;
+}
+
+static Opcode binaryOpcode(BinaryOpKind op, _Bool isSigned) {
+    switch (op) {
+    case BINARY_ADD: return OP_ADD;
+    case BINARY_SUB: return OP_SUB;
+    case BINARY_MUL: return OP_MUL;
+    case BINARY_DIV: return isSigned ? OP_DIV : OP_DIVU;
+    case BINARY_MOD: return isSigned ? OP_MOD : OP_MODU;
+    case BINARY_SHL: return OP_SHL;
+    case BINARY_SHR: return isSigned ? OP_SHR : OP_SHRU;
+    case BINARY_LESS: return isSigned ? OP_LT : OP_LTU;
+    case BINARY_LEQ: return isSigned ? OP_LE : OP_LEU;
+    case BINARY_GREATER: return isSigned ? OP_GT : OP_GTU;
+    case BINARY_GEQ: return isSigned ? OP_GE : OP_GEU;
+    case BINARY_EQUAL: return OP_EQ;
+    case BINARY_NEQ: return OP_NE;
+    case BINARY_BITAND: return OP_AND;
+    case BINARY_BITXOR: return OP_XOR;
+    case BINARY_BITOR: return OP_OR;
+    default: return NUM_OPCODES;
+    }
+}
+
+// compareBranchOpcode - Return the fused compare-and-branch opcode for a
+// comparison, or NUM_OPCODES if op is not a comparison. If negate is set, the
+// branch is taken when the comparison is false.
+static Opcode compareBranchOpcode(BinaryOpKind op, _Bool negate, _Bool isSigned) {
+    switch (op) {
+    case BINARY_LESS: return negate ? (isSigned ? OP_JGE : OP_JGEU) : (isSigned ? OP_JLT : OP_JLTU);
+    case BINARY_LEQ: return negate ? (isSigned ? OP_JGT : OP_JGTU) : (isSigned ? OP_JLE : OP_JLEU);
+    case BINARY_GREATER: return negate ? (isSigned ? OP_JLE : OP_JLEU) : (isSigned ? OP_JGT : OP_JGTU);
+    case BINARY_GEQ: return negate ? (isSigned ? OP_JLT : OP_JLTU) : (isSigned ? OP_JGE : OP_JGEU);
+    case BINARY_EQUAL: return negate ? OP_JNE : OP_JEQ;
+    case BINARY_NEQ: return negate ? OP_JEQ : OP_JNE;
+    default: return NUM_OPCODES;
+    }
+}
+
+static void lowerExprInto(Lowering *l, Expr *e, unsigned dst);
+
+// lowerOperand - Lower e into dst and convert its value to fmt.
+static void lowerOperand(Lowering *l, Expr *e, unsigned dst, IntegerFormat fmt) {
+    lowerExprInto(l, e, dst);
+    emitConvert(l, dst, formatOf(l, e), fmt);
+}
+
+// lowerCondJump - Emit a jump that is taken when e evaluates to jumpIfTrue.
+// Return the index of the jump so that the caller can patch its target, or
+// NO_JUMP if e is a constant that never takes it.
+static unsigned lowerCondJump(Lowering *l, Expr *e, _Bool jumpIfTrue) {
+    long long value;
+    if (evaluateAsInt(e, &value)) {
+        if ((value != 0) != jumpIfTrue)
+            return NO_JUMP;
+        return emitInstr(l->chunk, OP_JMP, 0, 0, 0, 0);
+    }
+
+    if (e->kind == EXPR_UNARY && ((UnaryExpr *)e)->opKind == UNARY_LOGICNOT)
+        return lowerCondJump(l, ((UnaryExpr *)e)->operand, !jumpIfTrue);
+
+    if (e->kind == EXPR_BINARY) {
+        BinaryExpr *be = (BinaryExpr *)e;
+        IntegerFormat fmt = commonIntegerFormat(formatOf(l, be->lhs), formatOf(l, be->rhs));
+        Opcode op = compareBranchOpcode(be->opKind, !jumpIfTrue, fmt.isSigned);
+        if (op != NUM_OPCODES) {
+            unsigned lhs = allocReg(l);
+            lowerOperand(l, be->lhs, lhs, fmt);
+            unsigned rhs = allocReg(l);
+            lowerOperand(l, be->rhs, rhs, fmt);
+            unsigned at = emitInstr(l->chunk, op, lhs, rhs, 0, 0);
+            releaseReg(l, rhs);
+            releaseReg(l, lhs);
+            return at;
+        }
+    }
+
+    unsigned cond = allocReg(l);
+    lowerExprInto(l, e, cond);
+    unsigned at = emitInstr(l->chunk, jumpIfTrue ? OP_JNZ : OP_JZ, cond, 0, 0, 0);
+    releaseReg(l, cond);
+    return at;
+}
+
+// lowerLogicalExpr - Lower && and || with short-circuit evaluation, leaving
+// 0 or 1 in dst.
+static void lowerLogicalExpr(Lowering *l, BinaryExpr *be, unsigned dst) {
+    Chunk *chunk = l->chunk;
+    _Bool isAnd = be->opKind == BINARY_LOGICAND;
+
+    // For && both operands must be true, so either failing jumps to the false
+    // result. For || the first true operand decides it.
+    unsigned first = lowerCondJump(l, be->lhs, !isAnd);
+    unsigned second = lowerCondJump(l, be->rhs, !isAnd);
+    emitInstr(chunk, OP_LOADK, dst, 0, 0, isAnd ? 1 : 0);
+    unsigned toEnd = emitInstr(chunk, OP_JMP, 0, 0, 0, 0);
+    patchJump(chunk, first);
+    patchJump(chunk, second);
+    emitInstr(chunk, OP_LOADK, dst, 0, 0, isAnd ? 0 : 1);
+    patchJump(chunk, toEnd);
+}
+
+static void lowerBinaryExpr(Lowering *l, BinaryExpr *be, unsigned dst) {
+    switch (be->opKind) {
+    case BINARY_LOGICAND:
+    case BINARY_LOGICOR:
+        return lowerLogicalExpr(l, be, dst);
+    case BINARY_COMMA: {
+        unsigned discard = allocReg(l);
+        lowerExprInto(l, be->lhs, discard);
+        releaseReg(l, discard);
+        return lowerOperand(l, be->rhs, dst, formatOf(l, (Expr *)be));
+    }
+    default:
+        break;
+    }
+
+    // Shift operands are promoted separately, the others are converted to
+    // their common type. Comparisons yield 0 or 1, which fits any type.
+    _Bool isShift = be->opKind == BINARY_SHL || be->opKind == BINARY_SHR;
+    IntegerFormat lhsFmt = formatOf(l, be->lhs);
+    IntegerFormat rhsFmt = formatOf(l, be->rhs);
+    IntegerFormat opFmt = isShift ? promoteInteger(lhsFmt) : commonIntegerFormat(lhsFmt, rhsFmt);
+    rhsFmt = isShift ? promoteInteger(rhsFmt) : opFmt;
+
+    Opcode op = binaryOpcode(be->opKind, opFmt.isSigned);
+    if (op == NUM_OPCODES) {
+        l->failed = 1;
+        return;
+    }
+    _Bool isComparison = be->opKind >= BINARY_LESS && be->opKind <= BINARY_NEQ;
+
+    lowerOperand(l, be->lhs, dst, opFmt);
+
+    long long value;
+    if (evaluateAsInt(be->rhs, &value)) {
+        value = truncateInteger(value, rhsFmt);
+
+        // x + 0, x * 1, x | 0 and friends leave x unchanged.
+        if (value == 0 && (op == OP_ADD || op == OP_SUB || op == OP_SHL || op == OP_SHR || op == OP_SHRU || op == OP_XOR || op == OP_OR))
+            return emitConvert(l, dst, opFmt, formatOf(l, (Expr *)be));
+        if (value == 1 && (op == OP_MUL || op == OP_DIV || op == OP_DIVU))
+            return emitConvert(l, dst, opFmt, formatOf(l, (Expr *)be));
+
+        // x + C and x - C are common enough to deserve their own instruction.
+        if (op == OP_ADD || op == OP_SUB) {
+            emitInstr(l->chunk, OP_ADDK, dst, dst, 0, op == OP_ADD ? value : (long long)(0ULL - (unsigned long long)value));
+            emitNormalize(l, dst, opFmt);
+            return emitConvert(l, dst, opFmt, formatOf(l, (Expr *)be));
+        }
+
+        // Multiplying by a constant needs no second register, and a power of
+        // two reduces to a shift.
+        if (op == OP_MUL) {
+            int shift = exactLog2(value);
+            if (shift >= 0)
+                emitInstr(l->chunk, OP_SHLK, dst, dst, 0, shift);
+            else
+                emitInstr(l->chunk, OP_MULK, dst, dst, 0, value);
+            emitNormalize(l, dst, opFmt);
+            return emitConvert(l, dst, opFmt, formatOf(l, (Expr *)be));
+        }
+    }
+
+    unsigned rhs = allocReg(l);
+    lowerOperand(l, be->rhs, rhs, rhsFmt);
+    emitInstr(l->chunk, op, dst, dst, rhs, opFmt.width);
+    releaseReg(l, rhs);
+    if (isComparison)
+        return;
+    // Only these can leave the range of opFmt; the rest stay within it when
+    // their operands do.
+    if (op == OP_ADD || op == OP_SUB || op == OP_MUL || op == OP_DIV || op == OP_SHL)
+        emitNormalize(l, dst, opFmt);
+    emitConvert(l, dst, opFmt, formatOf(l, (Expr *)be));
+}
+
+static void lowerUnaryExpr(Lowering *l, UnaryExpr *ue, unsigned dst) {
+    Opcode op;
+    switch (ue->opKind) {
+    case UNARY_PLUS: op = NUM_OPCODES; break;
+    case UNARY_MINUS: op = OP_NEG; break;
+    case UNARY_BITNOT: op = OP_NOT; break;
+    case UNARY_LOGICNOT:
+        lowerExprInto(l, ue->operand, dst);
+        emitInstr(l->chunk, OP_LNOT, dst, dst, 0, 0);
+        return;
+    default:
+        l->failed = 1;
+        return;
+    }
+    IntegerFormat fmt = promoteInteger(formatOf(l, ue->operand));
+    lowerOperand(l, ue->operand, dst, fmt);
+    if (op != NUM_OPCODES) {
+        emitInstr(l->chunk, op, dst, dst, 0, 0);
+        emitNormalize(l, dst, fmt);
+    }
+    emitConvert(l, dst, fmt, formatOf(l, (Expr *)ue));
+}
+
+static void lowerTernaryExpr(Lowering *l, TernaryExpr *te, unsigned dst) {
+    Chunk *chunk = l->chunk;
+    IntegerFormat fmt = formatOf(l, (Expr *)te);
+
+    // Only the selected arm of a constant condition is ever evaluated.
+    long long value;
+    if (evaluateAsInt(te->condExpr, &value))
+        return lowerOperand(l, value ? te->trueExpr : te->falseExpr, dst, fmt);
+
+    unsigned toFalse = lowerCondJump(l, te->condExpr, 0);
+    lowerOperand(l, te->trueExpr, dst, fmt);
+    unsigned toEnd = emitInstr(chunk, OP_JMP, 0, 0, 0, 0);
+    patchJump(chunk, toFalse);
+    lowerOperand(l, te->falseExpr, dst, fmt);
+    patchJump(chunk, toEnd);
+}
+
+// lowerDeclRefExpr - Parameters live in the first registers, so a reference
+// is just a copy.
+static void lowerDeclRefExpr(Lowering *l, DeclRefExpr *dre, unsigned dst) {
+    for (unsigned i = 0; i < l->numParams; ++i) {
+        if ((Decl *)l->params[i] == dre->decl) {
+            emitInstr(l->chunk, OP_MOV, dst, i, 0, 0);
+            return;
+        }
+    }
+    l->failed = 1;
+}
+
+static void lowerExprInto(Lowering *l, Expr *e, unsigned dst) {
+    // Constants of integer type, including every IntegerConstant and
+    // CharacterConstant, fold here.
+    long long value;
+    if (evaluateAsInt(e, &value)) {
+        emitInstr(l->chunk, OP_LOADK, dst, 0, 0, value);
+        return;
+    }
+
+    switch (e->kind) {
+    case EXPR_DECLREF:
+        return lowerDeclRefExpr(l, (DeclRefExpr *)e, dst);
+    case EXPR_UNARY:
+        return lowerUnaryExpr(l, (UnaryExpr *)e, dst);
+    case EXPR_BINARY:
+        return lowerBinaryExpr(l, (BinaryExpr *)e, dst);
+    case EXPR_TERNARY:
+        return lowerTernaryExpr(l, (TernaryExpr *)e, dst);
+    default:
+        l->failed = 1;
+        return;
+    }
+}
+
+_Bool compileExpr(Chunk *chunk, Expr *e, VarDecl **params, unsigned numParams) {
+    Lowering l;
+    l.chunk = chunk;
+    l.nextReg = 0;
+    l.params = params;
+    l.numParams = numParams;
+    l.failed = 0;
+
+    // Arguments arrive as plain 64-bit values; bring each into the range of
+    // its parameter's type.
+    chunk->numParams = numParams;
+    for (unsigned i = 0; i < numParams; ++i) {
+        unsigned reg = allocReg(&l);
+        IntegerFormat fmt;
+        if (!getIntegerFormat(params[i]->type, &fmt))
+            l.failed = 1;
+        else
+            emitNormalize(&l, reg, fmt);
+    }
+
+    unsigned result = allocReg(&l);
+    lowerExprInto(&l, e, result);
+    emitInstr(chunk, OP_RET, result, 0, 0, 0);
+    return !l.failed;
+}
+
+const char *getRunStatusMessage(RunStatus status) {
+    switch (status) {
+    case RUN_OK: return "ok";
+    case RUN_DIVIDE_BY_ZERO: return "division by zero";
+    case RUN_DIVIDE_OVERFLOW: return "division overflow";
+    case RUN_SHIFT_OUT_OF_RANGE: return "shift count out of range";
+    default: return "unknown error";
+    }
+}
+
+#ifdef CRYOLITE_COMPUTED_GOTO
+#define VM_DISPATCH() goto *dispatchTable[(in = ip++)->op];
+#define VM_CASE(name) do_##name
+#define VM_NEXT() goto *dispatchTable[(in = ip++)->op]
+#else
+#define VM_DISPATCH() for (;;) switch ((in = ip++)->op)
+#define VM_CASE(name) case OP_##name
+#define VM_NEXT() continue
+#endif
+
+// Registers are signed, but arithmetic goes through unsigned so that it wraps
+// instead of being undefined in the host.
+#define U(x) ((unsigned long long)(x))
+#define S(x) ((long long)(x))
+
+RunStatus runChunk(const Chunk *chunk, const long long *args, long long *result) {
+#ifdef CRYOLITE_COMPUTED_GOTO
+    static const void *dispatchTable[NUM_OPCODES] = {
+        [OP_LOADK] = &&do_LOADK, [OP_MOV] = &&do_MOV, [OP_SEXT] = &&do_SEXT,
+        [OP_ZEXT] = &&do_ZEXT, [OP_BOOL] = &&do_BOOL,
+        [OP_NEG] = &&do_NEG, [OP_NOT] = &&do_NOT, [OP_LNOT] = &&do_LNOT,
+        [OP_ADD] = &&do_ADD, [OP_SUB] = &&do_SUB, [OP_MUL] = &&do_MUL,
+        [OP_DIV] = &&do_DIV, [OP_DIVU] = &&do_DIVU, [OP_MOD] = &&do_MOD,
+        [OP_MODU] = &&do_MODU, [OP_SHL] = &&do_SHL, [OP_SHR] = &&do_SHR,
+        [OP_SHRU] = &&do_SHRU, [OP_AND] = &&do_AND, [OP_XOR] = &&do_XOR,
+        [OP_OR] = &&do_OR, [OP_LT] = &&do_LT, [OP_LE] = &&do_LE,
+        [OP_GT] = &&do_GT, [OP_GE] = &&do_GE, [OP_LTU] = &&do_LTU,
+        [OP_LEU] = &&do_LEU, [OP_GTU] = &&do_GTU, [OP_GEU] = &&do_GEU,
+        [OP_EQ] = &&do_EQ, [OP_NE] = &&do_NE, [OP_JMP] = &&do_JMP,
+        [OP_JZ] = &&do_JZ, [OP_JNZ] = &&do_JNZ, [OP_ADDK] = &&do_ADDK,
+        [OP_MULK] = &&do_MULK, [OP_SHLK] = &&do_SHLK, [OP_JLT] = &&do_JLT,
+        [OP_JLE] = &&do_JLE, [OP_JGT] = &&do_JGT, [OP_JGE] = &&do_JGE,
+        [OP_JLTU] = &&do_JLTU, [OP_JLEU] = &&do_JLEU, [OP_JGTU] = &&do_JGTU,
+        [OP_JGEU] = &&do_JGEU, [OP_JEQ] = &&do_JEQ, [OP_JNE] = &&do_JNE,
+        [OP_RET] = &&do_RET,
+    };
+#endif
+    long long r[MAX_REGISTERS];
+    const Instr *code = chunk->code;
+    const Instr *ip = code;
+    const Instr *in;
+
+    for (unsigned i = 0; i < chunk->numParams; ++i)
+        r[i] = args[i];
+
+    VM_DISPATCH() {
+    VM_CASE(LOADK): r[in->a] = in->k; VM_NEXT();
+    VM_CASE(MOV): r[in->a] = r[in->b]; VM_NEXT();
+    VM_CASE(SEXT): {
+        unsigned long long signBit = 1ULL << (in->k - 1);
+        r[in->a] = S(((U(r[in->b]) & ((signBit << 1) - 1)) ^ signBit) - signBit);
+        VM_NEXT();
+    }
+    VM_CASE(ZEXT): r[in->a] = S(U(r[in->b]) & ((1ULL << in->k) - 1)); VM_NEXT();
+    VM_CASE(BOOL): r[in->a] = r[in->b] != 0; VM_NEXT();
+
+    VM_CASE(NEG): r[in->a] = S(0ULL - U(r[in->b])); VM_NEXT();
+    VM_CASE(NOT): r[in->a] = ~r[in->b]; VM_NEXT();
+    VM_CASE(LNOT): r[in->a] = !r[in->b]; VM_NEXT();
+
+    VM_CASE(ADD): r[in->a] = S(U(r[in->b]) + U(r[in->c])); VM_NEXT();
+    VM_CASE(SUB): r[in->a] = S(U(r[in->b]) - U(r[in->c])); VM_NEXT();
+    VM_CASE(MUL): r[in->a] = S(U(r[in->b]) * U(r[in->c])); VM_NEXT();
+    VM_CASE(DIV):
+        if (!r[in->c]) goto divideByZero;
+        if (r[in->c] == -1 && r[in->b] == S(~0ULL << (in->k - 1))) goto divideOverflow;
+        r[in->a] = r[in->b] / r[in->c];
+        VM_NEXT();
+    VM_CASE(DIVU):
+        if (!r[in->c]) goto divideByZero;
+        r[in->a] = S(U(r[in->b]) / U(r[in->c]));
+        VM_NEXT();
+    VM_CASE(MOD):
+        if (!r[in->c]) goto divideByZero;
+        if (r[in->c] == -1 && r[in->b] == S(~0ULL << (in->k - 1))) goto divideOverflow;
+        r[in->a] = r[in->b] % r[in->c];
+        VM_NEXT();
+    VM_CASE(MODU):
+        if (!r[in->c]) goto divideByZero;
+        r[in->a] = S(U(r[in->b]) % U(r[in->c]));
+        VM_NEXT();
+    VM_CASE(SHL):
+        if (U(r[in->c]) >= U(in->k)) goto shiftOutOfRange;
+        r[in->a] = S(U(r[in->b]) << r[in->c]);
+        VM_NEXT();
+    VM_CASE(SHR):
+        if (U(r[in->c]) >= U(in->k)) goto shiftOutOfRange;
+        r[in->a] = r[in->b] < 0 ? ~(~r[in->b] >> r[in->c]) : r[in->b] >> r[in->c];
+        VM_NEXT();
+    VM_CASE(SHRU):
+        if (U(r[in->c]) >= U(in->k)) goto shiftOutOfRange;
+        r[in->a] = S(U(r[in->b]) >> r[in->c]);
+        VM_NEXT();
+    VM_CASE(AND): r[in->a] = r[in->b] & r[in->c]; VM_NEXT();
+    VM_CASE(XOR): r[in->a] = r[in->b] ^ r[in->c]; VM_NEXT();
+    VM_CASE(OR): r[in->a] = r[in->b] | r[in->c]; VM_NEXT();
+    VM_CASE(LT): r[in->a] = r[in->b] < r[in->c]; VM_NEXT();
+    VM_CASE(LE): r[in->a] = r[in->b] <= r[in->c]; VM_NEXT();
+    VM_CASE(GT): r[in->a] = r[in->b] > r[in->c]; VM_NEXT();
+    VM_CASE(GE): r[in->a] = r[in->b] >= r[in->c]; VM_NEXT();
+    VM_CASE(LTU): r[in->a] = U(r[in->b]) < U(r[in->c]); VM_NEXT();
+    VM_CASE(LEU): r[in->a] = U(r[in->b]) <= U(r[in->c]); VM_NEXT();
+    VM_CASE(GTU): r[in->a] = U(r[in->b]) > U(r[in->c]); VM_NEXT();
+    VM_CASE(GEU): r[in->a] = U(r[in->b]) >= U(r[in->c]); VM_NEXT();
+    VM_CASE(EQ): r[in->a] = r[in->b] == r[in->c]; VM_NEXT();
+    VM_CASE(NE): r[in->a] = r[in->b] != r[in->c]; VM_NEXT();
+
+    VM_CASE(JMP): ip = code + in->k; VM_NEXT();
+    VM_CASE(JZ): if (!r[in->a]) ip = code + in->k; VM_NEXT();
+    VM_CASE(JNZ): if (r[in->a]) ip = code + in->k; VM_NEXT();
+
+    VM_CASE(ADDK): r[in->a] = S(U(r[in->b]) + U(in->k)); VM_NEXT();
+    VM_CASE(MULK): r[in->a] = S(U(r[in->b]) * U(in->k)); VM_NEXT();
+    VM_CASE(SHLK): r[in->a] = S(U(r[in->b]) << in->k); VM_NEXT();
+    VM_CASE(JLT): if (r[in->a] < r[in->b]) ip = code + in->k; VM_NEXT();
+    VM_CASE(JLE): if (r[in->a] <= r[in->b]) ip = code + in->k; VM_NEXT();
+    VM_CASE(JGT): if (r[in->a] > r[in->b]) ip = code + in->k; VM_NEXT();
+    VM_CASE(JGE): if (r[in->a] >= r[in->b]) ip = code + in->k; VM_NEXT();
+    VM_CASE(JLTU): if (U(r[in->a]) < U(r[in->b])) ip = code + in->k; VM_NEXT();
+    VM_CASE(JLEU): if (U(r[in->a]) <= U(r[in->b])) ip = code + in->k; VM_NEXT();
+    VM_CASE(JGTU): if (U(r[in->a]) > U(r[in->b])) ip = code + in->k; VM_NEXT();
+    VM_CASE(JGEU): if (U(r[in->a]) >= U(r[in->b])) ip = code + in->k; VM_NEXT();
+    VM_CASE(JEQ): if (r[in->a] == r[in->b]) ip = code + in->k; VM_NEXT();
+    VM_CASE(JNE): if (r[in->a] != r[in->b]) ip = code + in->k; VM_NEXT();
+
+    VM_CASE(RET):
+        *result = r[in->a];
+        return RUN_OK;
+    }
+
+divideByZero:
+    return RUN_DIVIDE_BY_ZERO;
+divideOverflow:
+    return RUN_DIVIDE_OVERFLOW;
+shiftOutOfRange:
+    return RUN_SHIFT_OUT_OF_RANGE;
+}
@@ -0,0 +1,114 @@
+#ifndef _CRYOLITE_BYTECODE_H_
+#define _CRYOLITE_BYTECODE_H_
+
+#include "expr.h"
+
+// Opcode - Instructions of the register-based bytecode. Operands are named
+// a, b, c (register numbers) and k (an immediate or a jump target).
+//
+// Registers are 64 bits wide. A value of a narrower integer type is kept sign-
+// or zero-extended according to its type, which lowering restores with SEXT,
+// ZEXT or BOOL after any operation that may leave the type's range. Arithmetic
+// wraps modulo 2^64, so signed overflow never traps.
+typedef enum Opcode {
+    OP_LOADK, // r[a] = k
+    OP_MOV,   // r[a] = r[b]
+    OP_SEXT,  // r[a] = low k bits of r[b], sign-extended
+    OP_ZEXT,  // r[a] = low k bits of r[b], zero-extended
+    OP_BOOL,  // r[a] = r[b] != 0
+
+    OP_NEG,  // r[a] = -r[b]
+    OP_NOT,  // r[a] = ~r[b]
+    OP_LNOT, // r[a] = !r[b]
+
+    OP_ADD,  // r[a] = r[b] + r[c]
+    OP_SUB,  // r[a] = r[b] - r[c]
+    OP_MUL,  // r[a] = r[b] * r[c]
+    OP_DIV,  // r[a] = r[b] / r[c], signed, k is the operand width
+    OP_DIVU, // r[a] = r[b] / r[c], unsigned
+    OP_MOD,  // r[a] = r[b] % r[c], signed, k is the operand width
+    OP_MODU, // r[a] = r[b] % r[c], unsigned
+    OP_SHL,  // r[a] = r[b] << r[c], k is the operand width
+    OP_SHR,  // r[a] = r[b] >> r[c], arithmetic, k is the operand width
+    OP_SHRU, // r[a] = r[b] >> r[c], logical, k is the operand width
+    OP_AND,  // r[a] = r[b] & r[c]
+    OP_XOR,  // r[a] = r[b] ^ r[c]
+    OP_OR,   // r[a] = r[b] | r[c]
+    OP_LT,   // r[a] = r[b] < r[c]
+    OP_LE,   // r[a] = r[b] <= r[c]
+    OP_GT,   // r[a] = r[b] > r[c]
+    OP_GE,   // r[a] = r[b] >= r[c]
+    OP_LTU,  // r[a] = r[b] < r[c], unsigned
+    OP_LEU,  // r[a] = r[b] <= r[c], unsigned
+    OP_GTU,  // r[a] = r[b] > r[c], unsigned
+    OP_GEU,  // r[a] = r[b] >= r[c], unsigned
+    OP_EQ,   // r[a] = r[b] == r[c]
+    OP_NE,   // r[a] = r[b] != r[c]
+
+    OP_JMP, // goto k
+    OP_JZ,  // if (!r[a]) goto k
+    OP_JNZ, // if (r[a]) goto k
+
+    // Superinstructions. These fuse the most common instruction pairs so that
+    // they cost a single dispatch.
+    OP_ADDK, // r[a] = r[b] + k, i.e. LOADK followed by ADD.
+    OP_MULK, // r[a] = r[b] * k
+    OP_SHLK, // r[a] = r[b] << k
+    OP_JLT,  // if (r[a] < r[b]) goto k, i.e. LT followed by JNZ.
+    OP_JLE,  // if (r[a] <= r[b]) goto k
+    OP_JGT,  // if (r[a] > r[b]) goto k
+    OP_JGE,  // if (r[a] >= r[b]) goto k
+    OP_JLTU, // if (r[a] < r[b]) goto k, unsigned
+    OP_JLEU, // if (r[a] <= r[b]) goto k, unsigned
+    OP_JGTU, // if (r[a] > r[b]) goto k, unsigned
+    OP_JGEU, // if (r[a] >= r[b]) goto k, unsigned
+    OP_JEQ,  // if (r[a] == r[b]) goto k
+    OP_JNE,  // if (r[a] != r[b]) goto k
+
+    OP_RET, // return r[a]
+
+    NUM_OPCODES
+} Opcode;
+
+#define MAX_REGISTERS 256
+
+typedef struct Instr {
+    unsigned char op;
+    unsigned char a;
+    unsigned char b;
+    unsigned char c;
+    long long k;
+} Instr;
+
+// Chunk - A straight sequence of instructions together with the number of
+// registers it needs to run. The first numParams registers hold the arguments.
+typedef struct Chunk {
+    Instr *code;
+    unsigned size;
+    unsigned capacity;
+    unsigned numRegs;
+    unsigned numParams;
+} Chunk;
+
+// RunStatus - Result of runChunk. Anything but RUN_OK is a runtime error of the
+// program being run, which is reported instead of crashing the host.
+typedef enum RunStatus {
+    RUN_OK,
+    RUN_DIVIDE_BY_ZERO,
+    RUN_DIVIDE_OVERFLOW,
+    RUN_SHIFT_OUT_OF_RANGE,
+} RunStatus;
+
+void initChunk(Chunk *chunk);
+void freeChunk(Chunk *chunk);
+unsigned emitInstr(Chunk *chunk, Opcode op, unsigned a, unsigned b, unsigned c, long long k);
+
+// compileExpr - Lower an integer expression into chunk, followed by a RET of
+// its value. Every DeclRefExpr in e must refer to one of params, whose values
+// are passed to runChunk in the same order. Return false if e uses anything
+// lowering does not support yet, or needs more than MAX_REGISTERS registers.
+_Bool compileExpr(Chunk *chunk, Expr *e, VarDecl **params, unsigned numParams);
+RunStatus runChunk(const Chunk *chunk, const long long *args, long long *result);
+const char *getRunStatusMessage(RunStatus status);
+
+#endif
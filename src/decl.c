@@ -1 +1,7 @@
-#include "decl.h"
\ No newline at end of file
+#include "decl.h"
+
+void initVarDecl(VarDecl *vd, const char *name, QualType type) {
+    vd->decl.kind = DECL_VAR;
+    vd->name = name;
+    vd->type = type;
+}
@@ -1,8 +1,22 @@
 #ifndef _CRYOLITE_DECL_H_
 #define _CRYOLITE_DECL_H_
 
-typedef struct Decl {
+#include "type.h"
+
+typedef enum DeclKind {
+    DECL_VAR,
+} DeclKind;
 
+typedef struct Decl {
+    DeclKind kind;
 } Decl;
 
-#endif
\ No newline at end of file
+typedef struct VarDecl {
+    Decl decl;
+    const char *name;
+    QualType type;
+} VarDecl;
+
+void initVarDecl(VarDecl *vd, const char *name, QualType type);
+
+#endif
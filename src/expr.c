@@ -5,6 +5,11 @@ void initExpr(Expr *e, ExprKind kind, QualType t) {
     e->tr = t;
 }
 
+void initDeclRefExpr(DeclRefExpr *dre, Decl *decl, QualType type) {
+    initExpr((Expr *)dre, EXPR_DECLREF, type);
+    dre->decl = decl;
+}
+
 void initIntegerConstant(IntegerConstant *ic, long long value, QualType type) {
     initExpr((Expr *)ic, EXPR_INTEGER, type);
     ic->value = value;
@@ -33,4 +38,154 @@ void initBinaryExpr(BinaryExpr *be, BinaryOpKind op, Expr *lhs, Expr *rhs, QualT
     be->opKind = op;
     be->lhs = lhs;
     be->rhs = rhs;
-}
\ No newline at end of file
+}
+
+void initTernaryExpr(TernaryExpr *te, Expr *cond, Expr *lhs, Expr *rhs, QualType ty) {
+    initExpr((Expr *)te, EXPR_TERNARY, ty);
+    te->condExpr = cond;
+    te->trueExpr = lhs;
+    te->falseExpr = rhs;
+}
+
+// evaluateOperand - Fold e and convert its value to fmt.
+static _Bool evaluateOperand(Expr *e, IntegerFormat fmt, long long *result) {
+    long long value;
+    if (!evaluateAsInt(e, &value))
+        return 0;
+    *result = truncateInteger((unsigned long long)value, fmt);
+    return 1;
+}
+
+static _Bool evaluateUnaryAsInt(UnaryExpr *ue, long long *result) {
+    IntegerFormat fmt;
+    if (!getIntegerFormat(ue->operand->tr, &fmt))
+        return 0;
+    fmt = promoteInteger(fmt);
+    long long v;
+    if (!evaluateOperand(ue->operand, fmt, &v))
+        return 0;
+    switch (ue->opKind) {
+    case UNARY_PLUS: *result = v; return 1;
+    case UNARY_MINUS: *result = truncateInteger(0ULL - (unsigned long long)v, fmt); return 1;
+    case UNARY_BITNOT: *result = truncateInteger(~(unsigned long long)v, fmt); return 1;
+    case UNARY_LOGICNOT: *result = !v; return 1;
+    default: return 0;
+    }
+}
+
+static _Bool evaluateBinaryAsInt(BinaryExpr *be, long long *result) {
+    IntegerFormat lhsFmt, rhsFmt;
+    if (!getIntegerFormat(be->lhs->tr, &lhsFmt) || !getIntegerFormat(be->rhs->tr, &rhsFmt))
+        return 0;
+
+    long long l, r;
+    if (!evaluateAsInt(be->lhs, &l))
+        return 0;
+
+    // The right operand of && and || need not be constant if the left one
+    // already decides the result.
+    if (be->opKind == BINARY_LOGICAND && !l) {
+        *result = 0;
+        return 1;
+    }
+    if (be->opKind == BINARY_LOGICOR && l) {
+        *result = 1;
+        return 1;
+    }
+
+    if (!evaluateAsInt(be->rhs, &r))
+        return 0;
+
+    switch (be->opKind) {
+    case BINARY_LOGICAND:
+    case BINARY_LOGICOR: *result = r != 0; return 1;
+    case BINARY_COMMA: *result = r; return 1;
+    default: break;
+    }
+
+    // Shift operands are promoted separately, the others are converted to
+    // their common type.
+    _Bool isShift = be->opKind == BINARY_SHL || be->opKind == BINARY_SHR;
+    IntegerFormat fmt = isShift ? promoteInteger(lhsFmt) : commonIntegerFormat(lhsFmt, rhsFmt);
+    l = truncateInteger((unsigned long long)l, fmt);
+    r = truncateInteger((unsigned long long)r, isShift ? promoteInteger(rhsFmt) : fmt);
+
+    unsigned long long ul = (unsigned long long)l, ur = (unsigned long long)r;
+    unsigned long long value;
+    switch (be->opKind) {
+    case BINARY_ADD: value = ul + ur; break;
+    case BINARY_SUB: value = ul - ur; break;
+    case BINARY_MUL: value = ul * ur; break;
+    case BINARY_DIV:
+    case BINARY_MOD:
+        if (r == 0)
+            return 0;
+        if (fmt.isSigned) {
+            if (r == -1 && l == (long long)(~0ULL << (fmt.width - 1)))
+                return 0;
+            value = (unsigned long long)(be->opKind == BINARY_DIV ? l / r : l % r);
+        } else {
+            value = be->opKind == BINARY_DIV ? ul / ur : ul % ur;
+        }
+        break;
+    case BINARY_SHL:
+    case BINARY_SHR:
+        if (ur >= fmt.width)
+            return 0;
+        if (be->opKind == BINARY_SHL)
+            value = ul << ur;
+        else if (fmt.isSigned && l < 0)
+            value = (unsigned long long)~(~l >> ur);
+        else
+            value = ul >> ur;
+        break;
+    case BINARY_LESS: *result = fmt.isSigned ? l < r : ul < ur; return 1;
+    case BINARY_LEQ: *result = fmt.isSigned ? l <= r : ul <= ur; return 1;
+    case BINARY_GREATER: *result = fmt.isSigned ? l > r : ul > ur; return 1;
+    case BINARY_GEQ: *result = fmt.isSigned ? l >= r : ul >= ur; return 1;
+    case BINARY_EQUAL: *result = l == r; return 1;
+    case BINARY_NEQ: *result = l != r; return 1;
+    case BINARY_BITAND: value = ul & ur; break;
+    case BINARY_BITXOR: value = ul ^ ur; break;
+    case BINARY_BITOR: value = ul | ur; break;
+    default: return 0;
+    }
+    *result = truncateInteger(value, fmt);
+    return 1;
+}
+
+// evaluateAsIntUnchecked - Fold e without converting the result to e's type.
+static _Bool evaluateAsIntUnchecked(Expr *e, long long *result) {
+    switch (e->kind) {
+    case EXPR_INTEGER:
+        *result = ((IntegerConstant *)e)->value;
+        return 1;
+    case EXPR_CHARACTER:
+        *result = ((CharacterConstant *)e)->value;
+        return 1;
+    case EXPR_UNARY:
+        return evaluateUnaryAsInt((UnaryExpr *)e, result);
+    case EXPR_BINARY:
+        return evaluateBinaryAsInt((BinaryExpr *)e, result);
+    case EXPR_TERNARY: {
+        TernaryExpr *te = (TernaryExpr *)e;
+        long long cond;
+        if (!evaluateAsInt(te->condExpr, &cond))
+            return 0;
+        return evaluateAsInt(cond ? te->trueExpr : te->falseExpr, result);
+    }
+    default:
+        return 0;
+    }
+}
+
+_Bool evaluateAsInt(Expr *e, long long *result) {
+    IntegerFormat fmt;
+    if (!getIntegerFormat(e->tr, &fmt))
+        return 0;
+    long long value;
+    if (!evaluateAsIntUnchecked(e, &value))
+        return 0;
+    *result = truncateInteger((unsigned long long)value, fmt);
+    return 1;
+}
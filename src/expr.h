@@ -1,6 +1,7 @@
 #ifndef _CRYOLITE_EXPR_H_
 #define _CRYOLITE_EXPR_H_
 
+#include "decl.h"
 #include "type.h"
 
 typedef enum ExprKind {
@@ -27,8 +28,11 @@ void initExpr(Expr *e, ExprKind kind, QualType t);
 // object (in which case it is an lvalue) or a function (in which case it is a function designator).
 typedef struct DeclRefExpr {
     Expr expr;
+    Decl *decl;
 } DeclRefExpr;
 
+void initDeclRefExpr(DeclRefExpr *dre, Decl *decl, QualType type);
+
 typedef struct IntegerConstant {
     Expr expr;
     long long value;
@@ -136,6 +140,8 @@ typedef struct TernaryExpr {
     Expr *falseExpr;
 } TernaryExpr;
 
+void initTernaryExpr(TernaryExpr *te, Expr *cond, Expr *lhs, Expr *rhs, QualType ty);
+
 // ArraySubscriptExpr - [C99 6.5.2.1] Array Subscripting.
 typedef struct ArraySubscriptExpr {
     Expr expr;
@@ -149,4 +155,11 @@ typedef struct MemberExpr {
     Expr expr;
 } MemberExpr;
 
+// evaluateAsInt - Try to fold e to a constant of its integer type. Return false
+// if e is not constant, or if it divides by zero, overflows a division or
+// shifts by a count out of range; those are left to fail at run time. Other
+// signed overflow wraps at the width of the type, as it does in the bytecode
+// interpreter.
+_Bool evaluateAsInt(Expr *e, long long *result);
+
 #endif
\ No newline at end of file
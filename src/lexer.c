@@ -1,4 +1,5 @@
 #include "lexer.h"
+#include <assert.h>
 
 typedef enum CharFlags {
     CHAR_HORZ_WS  = 0x01,  // ' ', '\t', '\f', '\v'. Note, no '\0'
@@ -88,7 +89,22 @@ static inline _Bool isNumberBody(unsigned char c) {
     return (charInfo[c] & (CHAR_LETTER | CHAR_NUMBER | CHAR_UNDER | CHAR_PERIOD)) ? 1 : 0;
 }
 
-void initLexer(Lexer *lexer) {
+// initLexer - Lex the buffer [bufStart, bufEnd). The buffer must be null
+// terminated, i.e. *bufEnd == 0.
+void initLexer(Lexer *lexer, const char *bufStart, const char *bufEnd) {
+    lexer->bufferStart = bufStart;
+    lexer->bufferEnd = bufEnd;
+    lexer->bufferPtr = bufStart;
+}
+
+// seekLexer - Resume lexing at ptr, which must be a token boundary inside the
+// lexer's buffer, e.g. the start of a previously lexed token. Nothing before
+// ptr is looked at again, so after an edit only the tokens from the last
+// boundary before the change need to be re-lexed. An edit changes the buffer,
+// so call initLexer on the new buffer first and then seek into it.
+void seekLexer(Lexer *lexer, const char *ptr) {
+    assert(ptr >= lexer->bufferStart && ptr <= lexer->bufferEnd);
+    lexer->bufferPtr = ptr;
 }
 
 void lex(Lexer *lexer, Token *result) {
@@ -9,7 +9,8 @@ typedef struct Lexer {
     const char *bufferPtr;
 } Lexer;
 
-void initLexer(Lexer *lexer);
+void initLexer(Lexer *lexer, const char *bufStart, const char *bufEnd);
+void seekLexer(Lexer *lexer, const char *ptr);
 void lex(Lexer *lexer, Token *result);
 void lexTokenInternal(Lexer *lexer, Token *result);
 char getCharAndSize(const char *ptr, unsigned *size);
@@ -1 +1,8 @@
-#include "token.h"
\ No newline at end of file
+#include "token.h"
+
+// startToken - Reset tok before the lexer fills it in.
+void startToken(Token *tok) {
+    tok->kind = TK_UNKNOWN;
+    tok->length = 0;
+    tok->ptrData = 0;
+}
@@ -101,6 +101,10 @@ typedef enum TokenKind {
 
 typedef struct Token {
     TokenKind kind;
+    unsigned length;
+    void *ptrData;
 } Token;
 
+void startToken(Token *tok);
+
 #endif
\ No newline at end of file
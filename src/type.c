@@ -18,4 +18,64 @@ ArithType *newArithType(ArithKind k) {
     t->type.canonicalType.quals = 0;
     t->arithKind = k;
     return t;
-}
\ No newline at end of file
+}
+
+// getIntegerFormat - If t is an integer type, store its format in fmt and
+// return true.
+_Bool getIntegerFormat(QualType t, IntegerFormat *fmt) {
+    if (!t.t || t.t->canonicalType.t->kind != TYPE_ARITH)
+        return 0;
+    switch (((ArithType *)t.t->canonicalType.t)->arithKind) {
+    case ARITH_BOOL: fmt->width = 1; fmt->isSigned = 0; return 1;
+    case ARITH_CHAR_U:
+    case ARITH_UNSIGNED_CHAR: fmt->width = 8; fmt->isSigned = 0; return 1;
+    case ARITH_UNSIGNED_SHORT: fmt->width = 16; fmt->isSigned = 0; return 1;
+    case ARITH_UNSIGNED_INT: fmt->width = 32; fmt->isSigned = 0; return 1;
+    case ARITH_UNSIGNED_LONG:
+    case ARITH_UNSIGNED_LONG_LONG: fmt->width = 64; fmt->isSigned = 0; return 1;
+    case ARITH_CHAR_S:
+    case ARITH_SIGNED_CHAR: fmt->width = 8; fmt->isSigned = 1; return 1;
+    case ARITH_SHORT: fmt->width = 16; fmt->isSigned = 1; return 1;
+    case ARITH_INT: fmt->width = 32; fmt->isSigned = 1; return 1;
+    case ARITH_LONG:
+    case ARITH_LONG_LONG: fmt->width = 64; fmt->isSigned = 1; return 1;
+    default: return 0;
+    }
+}
+
+// promoteInteger - [C99 6.3.1.1p2] Integer promotions. Everything narrower than
+// int fits in int.
+IntegerFormat promoteInteger(IntegerFormat fmt) {
+    if (fmt.width < 32) {
+        fmt.width = 32;
+        fmt.isSigned = 1;
+    }
+    return fmt;
+}
+
+// commonIntegerFormat - [C99 6.3.1.8p1] Usual arithmetic conversions for two
+// integer operands.
+IntegerFormat commonIntegerFormat(IntegerFormat lhs, IntegerFormat rhs) {
+    lhs = promoteInteger(lhs);
+    rhs = promoteInteger(rhs);
+    if (lhs.isSigned == rhs.isSigned)
+        return lhs.width >= rhs.width ? lhs : rhs;
+    IntegerFormat s = lhs.isSigned ? lhs : rhs;
+    IntegerFormat u = lhs.isSigned ? rhs : lhs;
+    // A signed type wins only if it can represent every value of the unsigned one.
+    return s.width > u.width ? s : u;
+}
+
+// truncateInteger - Convert value, taken modulo 2^64, to fmt. The result is
+// sign- or zero-extended back to 64 bits. Converting to _Bool yields 0 or 1.
+long long truncateInteger(unsigned long long value, IntegerFormat fmt) {
+    if (fmt.width == 1)
+        return value != 0;
+    if (fmt.width >= 64)
+        return (long long)value;
+    unsigned long long signBit = 1ULL << (fmt.width - 1);
+    value &= (signBit << 1) - 1;
+    if (fmt.isSigned && (value & signBit))
+        value |= ~((signBit << 1) - 1);
+    return (long long)value;
+}
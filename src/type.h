@@ -111,4 +111,16 @@ extern QualType floatTy, doubleTy, longDoubleTy;
 VoidType *newVoidType();
 ArithType *newArithType(ArithKind k);
 
+// IntegerFormat - Width in bits and signedness of an integer type. Widths follow
+// the LP64 data model. _Bool has width 1.
+typedef struct IntegerFormat {
+    unsigned width;
+    _Bool isSigned;
+} IntegerFormat;
+
+_Bool getIntegerFormat(QualType t, IntegerFormat *fmt);
+IntegerFormat promoteInteger(IntegerFormat fmt);
+IntegerFormat commonIntegerFormat(IntegerFormat lhs, IntegerFormat rhs);
+long long truncateInteger(unsigned long long value, IntegerFormat fmt);
+
 #endif
\ No newline at end of file
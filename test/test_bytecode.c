@@ -0,0 +1,295 @@
+#include "bytecode.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static int failures;
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++failures;                                                     \
+        }                                                                   \
+    } while (0)
+
+static QualType arith(ArithKind k) {
+    QualType t;
+    t.quals = 0;
+    t.t = (Type *)newArithType(k);
+    return t;
+}
+
+static Expr *lit(long long value, QualType t) {
+    IntegerConstant *ic = (IntegerConstant *)malloc(sizeof(IntegerConstant));
+    initIntegerConstant(ic, value, t);
+    return (Expr *)ic;
+}
+
+static Expr *ref(VarDecl *vd) {
+    DeclRefExpr *dre = (DeclRefExpr *)malloc(sizeof(DeclRefExpr));
+    initDeclRefExpr(dre, (Decl *)vd, vd->type);
+    return (Expr *)dre;
+}
+
+static Expr *unary(UnaryOpKind op, Expr *operand, QualType t) {
+    UnaryExpr *ue = (UnaryExpr *)malloc(sizeof(UnaryExpr));
+    initUnaryExpr(ue, operand, op, t);
+    return (Expr *)ue;
+}
+
+static Expr *binary(BinaryOpKind op, Expr *lhs, Expr *rhs, QualType t) {
+    BinaryExpr *be = (BinaryExpr *)malloc(sizeof(BinaryExpr));
+    initBinaryExpr(be, op, lhs, rhs, t);
+    return (Expr *)be;
+}
+
+static Expr *ternary(Expr *cond, Expr *lhs, Expr *rhs, QualType t) {
+    TernaryExpr *te = (TernaryExpr *)malloc(sizeof(TernaryExpr));
+    initTernaryExpr(te, cond, lhs, rhs, t);
+    return (Expr *)te;
+}
+
+static QualType intT, uintT, longT, ucharT;
+static VarDecl x, y, u, v, c, i;
+static VarDecl *params[] = {&x, &y, &u, &v, &c, &i};
+#define NUM_PARAMS (sizeof(params) / sizeof(params[0]))
+
+// Args - Arguments for the parameters x, y (long), u, v (unsigned int),
+// c (unsigned char) and i (int), in that order.
+typedef struct Args {
+    long long values[NUM_PARAMS];
+} Args;
+
+static RunStatus run(Expr *e, Args args, long long *result) {
+    Chunk chunk;
+    initChunk(&chunk);
+    _Bool ok = compileExpr(&chunk, e, params, NUM_PARAMS);
+    CHECK(ok);
+    RunStatus status = ok ? runChunk(&chunk, args.values, result) : RUN_OK;
+    freeChunk(&chunk);
+    return status;
+}
+
+static Args longArgs(long long xv, long long yv) {
+    Args args = {{xv, yv, 0, 0, 0, 0}};
+    return args;
+}
+
+static Args narrowArgs(long long uv, long long vv, long long cv, long long iv) {
+    Args args = {{0, 0, uv, vv, cv, iv}};
+    return args;
+}
+
+static long long eval(Expr *e, long long xv, long long yv) {
+    long long result = 0;
+    CHECK(run(e, longArgs(xv, yv), &result) == RUN_OK);
+    return result;
+}
+
+static long long evalUnsigned(Expr *e, long long uv, long long vv, long long cv) {
+    long long result = 0;
+    CHECK(run(e, narrowArgs(uv, vv, cv, 0), &result) == RUN_OK);
+    return result;
+}
+
+static void testArithmetic(void) {
+    Expr *rx = ref(&x), *ry = ref(&y);
+    CHECK(eval(binary(BINARY_ADD, binary(BINARY_MUL, rx, ry, longT), lit(2, longT), longT), 7, 3) == 23);
+    CHECK(eval(binary(BINARY_SUB, rx, ry, longT), 7, 3) == 4);
+    CHECK(eval(binary(BINARY_DIV, rx, ry, longT), -7, 2) == -3);
+    CHECK(eval(binary(BINARY_MOD, rx, ry, longT), -7, 2) == -1);
+    CHECK(eval(binary(BINARY_SHR, rx, ry, longT), -16, 2) == -4);
+    CHECK(eval(binary(BINARY_SHL, rx, ry, longT), -1, 4) == -16);
+    CHECK(eval(unary(UNARY_MINUS, rx, longT), 5, 0) == -5);
+    CHECK(eval(unary(UNARY_BITNOT, rx, longT), 5, 0) == ~5LL);
+    CHECK(eval(unary(UNARY_LOGICNOT, rx, intT), 5, 0) == 0);
+    CHECK(eval(binary(BINARY_ADD, rx, ry, longT), LLONG_MAX, 1) == LLONG_MIN);
+}
+
+static void testControlFlow(void) {
+    Expr *rx = ref(&x), *ry = ref(&y);
+    Expr *min = ternary(binary(BINARY_LESS, rx, ry, intT), rx, ry, longT);
+    CHECK(eval(min, 3, 9) == 3);
+    CHECK(eval(min, 9, 3) == 3);
+    Expr *both = binary(BINARY_LOGICAND, rx, ry, intT);
+    CHECK(eval(both, 1, 2) == 1);
+    CHECK(eval(both, 1, 0) == 0);
+    Expr *either = binary(BINARY_LOGICOR, rx, ry, intT);
+    CHECK(eval(either, 0, 2) == 1);
+    CHECK(eval(either, 0, 0) == 0);
+    // The right operand is not evaluated once the left one decides.
+    Expr *guarded = binary(BINARY_LOGICAND, binary(BINARY_NEQ, ry, lit(0, longT), intT), binary(BINARY_DIV, rx, ry, longT), intT);
+    CHECK(eval(guarded, 4, 0) == 0);
+    CHECK(eval(binary(BINARY_COMMA, rx, ry, longT), 4, 5) == 5);
+}
+
+static void testUnsignedAndWidth(void) {
+    Expr *ru = ref(&u), *rv = ref(&v), *rc = ref(&c);
+    CHECK(evalUnsigned(binary(BINARY_ADD, ru, rv, uintT), 0xFFFFFFFF, 1, 0) == 0);
+    CHECK(evalUnsigned(binary(BINARY_SUB, ru, rv, uintT), 0, 1, 0) == 0xFFFFFFFF);
+    CHECK(evalUnsigned(binary(BINARY_SHR, ru, lit(4, intT), uintT), 0xFFFFFFFF, 0, 0) == 0x0FFFFFFF);
+    CHECK(evalUnsigned(binary(BINARY_DIV, ru, rv, uintT), 0xFFFFFFFF, 2, 0) == 0x7FFFFFFF);
+    CHECK(evalUnsigned(unary(UNARY_MINUS, ru, uintT), 1, 0, 0) == 0xFFFFFFFF);
+    // -1 < 1u compares as unsigned int.
+    CHECK(evalUnsigned(binary(BINARY_LESS, lit(-1, intT), ru, intT), 1, 0, 0) == 0);
+    CHECK(evalUnsigned(ternary(binary(BINARY_LESS, lit(-1, intT), ru, intT), lit(1, intT), lit(2, intT), intT), 1, 0, 0) == 2);
+    // unsigned char promotes to int.
+    CHECK(evalUnsigned(binary(BINARY_ADD, rc, lit(1, intT), intT), 0, 0, 255) == 256);
+    // Arguments are brought into the range of the parameter's type.
+    CHECK(evalUnsigned(ru, 0x1FFFFFFFFLL, 0, 0) == 0xFFFFFFFF);
+    // Signed int arithmetic wraps at 32 bits.
+    Expr *wrap = binary(BINARY_ADD, binary(BINARY_SUB, ru, ru, intT), lit(INT_MAX, intT), intT);
+    CHECK(evalUnsigned(binary(BINARY_ADD, wrap, lit(1, intT), intT), 0, 0, 0) == INT_MIN);
+}
+
+static void testRuntimeErrors(void) {
+    Expr *rx = ref(&x), *ry = ref(&y), *ru = ref(&u), *ri = ref(&i);
+    long long result;
+    CHECK(run(binary(BINARY_DIV, rx, ry, longT), longArgs(1, 0), &result) == RUN_DIVIDE_BY_ZERO);
+    CHECK(run(binary(BINARY_MOD, rx, ry, longT), longArgs(1, 0), &result) == RUN_DIVIDE_BY_ZERO);
+    CHECK(run(binary(BINARY_DIV, ru, ru, uintT), narrowArgs(0, 0, 0, 0), &result) == RUN_DIVIDE_BY_ZERO);
+    CHECK(run(binary(BINARY_DIV, rx, ry, longT), longArgs(LLONG_MIN, -1), &result) == RUN_DIVIDE_OVERFLOW);
+    CHECK(run(binary(BINARY_DIV, lit(INT_MIN, intT), ri, intT), narrowArgs(0, 0, 0, -1), &result) == RUN_DIVIDE_OVERFLOW);
+    // With a long divisor the division happens in long and cannot overflow.
+    CHECK(run(binary(BINARY_DIV, lit(INT_MIN, intT), ry, longT), longArgs(0, -1), &result) == RUN_OK && result == -(long long)INT_MIN);
+    CHECK(run(binary(BINARY_SHL, rx, ry, longT), longArgs(1, 64), &result) == RUN_SHIFT_OUT_OF_RANGE);
+    CHECK(run(binary(BINARY_SHR, rx, ry, longT), longArgs(1, -1), &result) == RUN_SHIFT_OUT_OF_RANGE);
+    CHECK(run(binary(BINARY_SHL, lit(1, intT), ry, intT), longArgs(0, 32), &result) == RUN_SHIFT_OUT_OF_RANGE);
+    CHECK(run(binary(BINARY_SHL, lit(1, intT), ry, intT), longArgs(0, 31), &result) == RUN_OK && result == INT_MIN);
+}
+
+// emits - Compile e over the long parameters x and y only, so that no argument
+// conversions are emitted, and compare the opcodes with expected.
+static _Bool emits(Expr *e, const Opcode *expected, unsigned numExpected) {
+    Chunk chunk;
+    initChunk(&chunk);
+    _Bool ok = compileExpr(&chunk, e, params, 2) && chunk.size == numExpected;
+    for (unsigned i = 0; ok && i < numExpected; ++i)
+        ok = chunk.code[i].op == expected[i];
+    freeChunk(&chunk);
+    return ok;
+}
+
+#define CHECK_EMITS(e, ...)                                                 \
+    do {                                                                    \
+        static const Opcode expected[] = {__VA_ARGS__};                     \
+        CHECK(emits(e, expected, sizeof(expected) / sizeof(expected[0])));  \
+    } while (0)
+
+static _Bool foldsTo(Expr *e, long long expected) {
+    long long value;
+    return evaluateAsInt(e, &value) && value == expected;
+}
+
+static _Bool doesNotFold(Expr *e) {
+    long long value;
+    return !evaluateAsInt(e, &value);
+}
+
+static void testFoldingValues(void) {
+    // Arithmetic happens at the width and signedness of the operands' type.
+    CHECK(foldsTo(binary(BINARY_ADD, lit(0xFFFFFFFF, uintT), lit(1, uintT), uintT), 0));
+    CHECK(foldsTo(binary(BINARY_LESS, lit(-1, intT), lit(1, uintT), intT), 0));
+    CHECK(foldsTo(binary(BINARY_DIV, lit(0xFFFFFFFF, uintT), lit(2, uintT), uintT), 0x7FFFFFFF));
+    CHECK(foldsTo(binary(BINARY_MOD, lit(-1, intT), lit(10, uintT), uintT), 5));
+    CHECK(foldsTo(binary(BINARY_SHR, lit(0x80000000, uintT), lit(31, intT), uintT), 1));
+    CHECK(foldsTo(binary(BINARY_SHR, lit(-8, intT), lit(1, intT), intT), -4));
+    CHECK(foldsTo(unary(UNARY_MINUS, lit(1, uintT), uintT), 0xFFFFFFFF));
+    CHECK(foldsTo(binary(BINARY_ADD, lit(255, ucharT), lit(1, intT), intT), 256));
+
+    // Signed overflow wraps, like the interpreter.
+    CHECK(foldsTo(binary(BINARY_ADD, lit(INT_MAX, intT), lit(1, intT), intT), INT_MIN));
+    CHECK(foldsTo(binary(BINARY_ADD, lit(LLONG_MAX, longT), lit(1, longT), longT), LLONG_MIN));
+    CHECK(foldsTo(unary(UNARY_MINUS, lit(LLONG_MIN, longT), longT), LLONG_MIN));
+
+    // What the interpreter reports as an error is left to it.
+    CHECK(doesNotFold(binary(BINARY_DIV, lit(1, intT), lit(0, intT), intT)));
+    CHECK(doesNotFold(binary(BINARY_DIV, lit(INT_MIN, intT), lit(-1, intT), intT)));
+    CHECK(doesNotFold(binary(BINARY_SHL, lit(1, intT), lit(32, intT), intT)));
+    CHECK(doesNotFold(binary(BINARY_SHL, lit(1, intT), lit(-1, intT), intT)));
+
+    // Only integer types fold.
+    CHECK(doesNotFold(lit(1, voidTy)));
+}
+
+static void testFoldingCode(void) {
+    Expr *rx = ref(&x), *ry = ref(&y);
+
+    // A constant subtree becomes one LOADK.
+    CHECK_EMITS(binary(BINARY_MUL, binary(BINARY_ADD, lit(2, longT), lit(3, longT), longT), lit(4, longT), longT), OP_LOADK, OP_RET);
+    CHECK_EMITS(binary(BINARY_ADD, rx, binary(BINARY_MUL, lit(2, longT), lit(3, longT), longT), longT), OP_MOV, OP_ADDK, OP_RET);
+
+    // Only the selected arm of a constant condition is lowered.
+    CHECK_EMITS(ternary(lit(1, intT), rx, ry, longT), OP_MOV, OP_RET);
+
+    // A constant operand of && or || emits no branch, or an unconditional one.
+    CHECK_EMITS(binary(BINARY_LOGICAND, lit(1, intT), rx, intT), OP_MOV, OP_JZ, OP_LOADK, OP_JMP, OP_LOADK, OP_RET);
+    CHECK_EMITS(binary(BINARY_LOGICOR, lit(0, intT), rx, intT), OP_MOV, OP_JNZ, OP_LOADK, OP_JMP, OP_LOADK, OP_RET);
+    CHECK_EMITS(binary(BINARY_LOGICAND, rx, lit(0, intT), intT), OP_MOV, OP_JZ, OP_JMP, OP_LOADK, OP_JMP, OP_LOADK, OP_RET);
+    CHECK(eval(binary(BINARY_LOGICAND, lit(1, intT), rx, intT), 3, 0) == 1);
+    CHECK(eval(binary(BINARY_LOGICAND, rx, lit(0, intT), intT), 3, 0) == 0);
+
+    // Identities emit nothing.
+    CHECK_EMITS(binary(BINARY_ADD, rx, lit(0, longT), longT), OP_MOV, OP_RET);
+    CHECK_EMITS(binary(BINARY_SUB, rx, lit(0, longT), longT), OP_MOV, OP_RET);
+    CHECK_EMITS(binary(BINARY_MUL, rx, lit(1, longT), longT), OP_MOV, OP_RET);
+    CHECK_EMITS(binary(BINARY_DIV, rx, lit(1, longT), longT), OP_MOV, OP_RET);
+    CHECK_EMITS(binary(BINARY_BITOR, rx, lit(0, longT), longT), OP_MOV, OP_RET);
+    CHECK_EMITS(binary(BINARY_SHR, rx, lit(0, intT), longT), OP_MOV, OP_RET);
+
+    // Comparisons in conditions fuse with the branch.
+    CHECK_EMITS(ternary(binary(BINARY_LESS, rx, ry, intT), rx, ry, longT), OP_MOV, OP_MOV, OP_JGE, OP_MOV, OP_JMP, OP_MOV, OP_RET);
+}
+
+static void testStrengthReduction(void) {
+    Expr *rx = ref(&x), *ri = ref(&i);
+
+    CHECK_EMITS(binary(BINARY_MUL, rx, lit(8, longT), longT), OP_MOV, OP_SHLK, OP_RET);
+    CHECK_EMITS(binary(BINARY_MUL, rx, lit(6, longT), longT), OP_MOV, OP_MULK, OP_RET);
+    CHECK_EMITS(binary(BINARY_MUL, rx, lit(-4, longT), longT), OP_MOV, OP_MULK, OP_RET);
+    CHECK(eval(binary(BINARY_MUL, rx, lit(8, longT), longT), -7, 0) == -56);
+    CHECK(eval(binary(BINARY_MUL, rx, lit(6, longT), longT), -7, 0) == -42);
+    CHECK(eval(binary(BINARY_MUL, rx, lit(-4, longT), longT), -7, 0) == 28);
+
+    // The shifted value still wraps at the width of int.
+    long long result;
+    CHECK(run(binary(BINARY_MUL, ri, lit(2, intT), intT), narrowArgs(0, 0, 0, INT_MAX), &result) == RUN_OK && result == -2);
+    CHECK(run(binary(BINARY_MUL, ri, lit(3, intT), intT), narrowArgs(0, 0, 0, INT_MAX), &result) == RUN_OK && result == INT_MAX - 2);
+}
+
+static void testTooManyRegisters(void) {
+    Expr *e = ref(&x);
+    for (int i = 0; i < MAX_REGISTERS + 8; ++i)
+        e = binary(BINARY_ADD, ref(&x), e, longT);
+    Chunk chunk;
+    initChunk(&chunk);
+    CHECK(!compileExpr(&chunk, e, params, NUM_PARAMS));
+    freeChunk(&chunk);
+}
+
+int main(void) {
+    intT = arith(ARITH_INT);
+    uintT = arith(ARITH_UNSIGNED_INT);
+    longT = arith(ARITH_LONG);
+    ucharT = arith(ARITH_UNSIGNED_CHAR);
+    initVarDecl(&x, "x", longT);
+    initVarDecl(&y, "y", longT);
+    initVarDecl(&u, "u", uintT);
+    initVarDecl(&v, "v", uintT);
+    initVarDecl(&c, "c", ucharT);
+    initVarDecl(&i, "i", intT);
+
+    testArithmetic();
+    testControlFlow();
+    testUnsignedAndWidth();
+    testRuntimeErrors();
+    testFoldingValues();
+    testFoldingCode();
+    testStrengthReduction();
+    testTooManyRegisters();
+
+    if (failures)
+        fprintf(stderr, "%d check(s) failed\n", failures);
+    return failures != 0;
+}
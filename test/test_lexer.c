@@ -0,0 +1,62 @@
+#include "lexer.h"
+#include <stdio.h>
+#include <string.h>
+
+static int failures;
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++failures;                                                     \
+        }                                                                   \
+    } while (0)
+
+static _Bool isNumber(const Token *tok, const char *spelling) {
+    return tok->kind == TK_NUMERIC_CONSTANT && tok->length == strlen(spelling) &&
+           memcmp(tok->ptrData, spelling, tok->length) == 0;
+}
+
+static void testSeek(void) {
+    const char buf[] = "12 345";
+    Lexer lexer;
+    Token tok;
+    initLexer(&lexer, buf, buf + sizeof(buf) - 1);
+
+    lex(&lexer, &tok);
+    CHECK(isNumber(&tok, "12"));
+
+    // Jump back to the start, then straight to the second token.
+    seekLexer(&lexer, buf);
+    lex(&lexer, &tok);
+    CHECK(isNumber(&tok, "12"));
+    seekLexer(&lexer, buf + 3);
+    lex(&lexer, &tok);
+    CHECK(isNumber(&tok, "345"));
+}
+
+static void testRelexAfterEdit(void) {
+    const char before[] = "12 345";
+    const char after[] = "12 6789";
+    Lexer lexer;
+    Token tok;
+    initLexer(&lexer, before, before + sizeof(before) - 1);
+    lex(&lexer, &tok);
+    CHECK(isNumber(&tok, "12"));
+
+    // The edit starts at offset 3, which was the start of a token.
+    initLexer(&lexer, after, after + sizeof(after) - 1);
+    seekLexer(&lexer, after + 3);
+    lex(&lexer, &tok);
+    CHECK(isNumber(&tok, "6789"));
+    CHECK(lexer.bufferPtr == lexer.bufferEnd);
+}
+
+int main(void) {
+    testSeek();
+    testRelexAfterEdit();
+
+    if (failures)
+        fprintf(stderr, "%d check(s) failed\n", failures);
+    return failures != 0;
+}